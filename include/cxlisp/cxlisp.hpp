@@ -1,6 +1,7 @@
 #ifndef CXLISP_HPP
 
 #include "ast/ast.hpp"
+#include "parser/incremental.hpp"
 #include "parser/parser.hpp"
 #include "util/util.hpp"
 #include "vm/vm.hpp"
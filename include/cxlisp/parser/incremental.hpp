@@ -0,0 +1,304 @@
+/*******************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ ******************************************************************************/
+
+#ifndef CXLISP_PARSER_INCREMENTAL_HPP_
+#define CXLISP_PARSER_INCREMENTAL_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "cxlisp/parser/parser.hpp"
+#include "cxlisp/util/vector.hpp"
+
+namespace cxlisp::parser::incremental {
+
+// Arbitrary, can be increased
+constexpr std::size_t kMaxForms = 1024;
+
+/**
+ * A top-level form: its byte range in the source and a hash of its text.
+ */
+struct Form {
+  std::size_t begin = 0;
+  std::size_t end = 0;
+  std::uint64_t hash = 0;
+
+  constexpr auto size() const { return end - begin; }
+  constexpr auto text(std::string_view src) const {
+    return src.substr(begin, size());
+  }
+  constexpr auto sameText(const Form &rhs) const {
+    return hash == rhs.hash && size() == rhs.size();
+  }
+};
+
+using FormTable = util::Vector<Form, kMaxForms>;
+
+/**
+ * How two form tables line up: the first `front` forms are identical and in
+ * place, the last `back` forms are identical but may have moved. Everything
+ * in between has to be looked at again.
+ */
+struct Delta {
+  std::size_t front = 0;
+  std::size_t back = 0;
+};
+
+struct Rescan {
+  FormTable forms{};
+  Delta delta{};
+};
+
+/**
+ * A byte-level edit: `removed` bytes at `offset` were replaced by `inserted`
+ * bytes.
+ */
+struct Edit {
+  std::size_t offset = 0;
+  std::size_t removed = 0;
+  std::size_t inserted = 0;
+};
+
+// FNV-1a
+constexpr std::uint64_t hashForm(std::string_view sv) {
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (auto c : sv) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+namespace detail {
+
+constexpr bool isWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Matches the delimiters used by parseAtom()
+constexpr bool isDelimiter(char c) {
+  return isWhitespace(c) || c == '(' || c == ')' || c == '"' || c == ';';
+}
+
+constexpr std::size_t skipTrivia(std::string_view src, std::size_t pos) {
+  while (pos < src.size()) {
+    if (isWhitespace(src[pos])) {
+      ++pos;
+    } else if (src[pos] == ';') {
+      while (pos < src.size() && src[pos] != '\n')
+        ++pos;
+    } else {
+      break;
+    }
+  }
+  return pos;
+}
+
+// Returns one past the end of the datum starting at `pos`.
+constexpr std::optional<std::size_t> scanDatum(std::string_view src,
+                                               std::size_t pos) {
+  std::size_t depth = 0;
+  while (pos < src.size()) {
+    const char c = src[pos];
+    if (c == '(') {
+      ++depth, ++pos;
+    } else if (c == ')') {
+      if (depth == 0)
+        return std::nullopt;
+      ++pos;
+      if (--depth == 0)
+        return pos;
+    } else if (c == '"') {
+      const auto close = src.find('"', pos + 1);
+      if (close == std::string_view::npos)
+        return std::nullopt;
+      pos = close + 1;
+      if (depth == 0)
+        return pos;
+    } else if (c == ';' || isWhitespace(c)) {
+      pos = skipTrivia(src, pos);
+    } else {
+      const auto start = pos;
+      while (pos < src.size() && !isDelimiter(src[pos]))
+        ++pos;
+      // A quote prefix belongs to the datum that follows it
+      const auto token = src.substr(start, pos - start);
+      const auto prefix =
+          token.find_first_not_of("'`,@") == std::string_view::npos;
+      if (depth == 0 && !prefix)
+        return pos;
+    }
+  }
+  return std::nullopt;
+}
+
+constexpr std::size_t shifted(std::size_t pos, std::ptrdiff_t shift) {
+  return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(pos) + shift);
+}
+
+} // namespace detail
+
+/**
+ * Scans the top-level form starting at or after `pos`. Yields an empty form
+ * at the end of input, and nothing if the form is unbalanced.
+ */
+constexpr std::optional<Form> scanForm(std::string_view src, std::size_t pos) {
+  const auto begin = detail::skipTrivia(src, pos);
+  if (begin == src.size())
+    return Form{begin, begin, 0};
+  const auto end = detail::scanDatum(src, begin);
+  if (!end)
+    return std::nullopt;
+  return Form{begin, *end, hashForm(src.substr(begin, *end - begin))};
+}
+
+constexpr std::optional<FormTable> scanForms(std::string_view src) {
+  FormTable forms{};
+  for (std::size_t pos = 0;;) {
+    const auto form = scanForm(src, pos);
+    if (!form)
+      return std::nullopt;
+    if (form->size() == 0)
+      return forms;
+    pos = form->end;
+    forms.push_back(Form(*form));
+  }
+}
+
+/**
+ * Lines up two complete scans of the same file, e.g. an old and a new version
+ * read from disk.
+ */
+constexpr Delta diffForms(const FormTable &prev, const FormTable &next) {
+  Delta delta{};
+  const auto common = prev.size() < next.size() ? prev.size() : next.size();
+  while (delta.front < common &&
+         prev[delta.front].begin == next[delta.front].begin &&
+         prev[delta.front].sameText(next[delta.front]))
+    ++delta.front;
+  while (delta.front + delta.back < common &&
+         prev[prev.size() - delta.back - 1].sameText(
+             next[next.size() - delta.back - 1]))
+    ++delta.back;
+  return delta;
+}
+
+/**
+ * Rescans `src` after `edit` was applied to the text `prev` was scanned from.
+ * Only the forms between the last one ending before the edit and the first
+ * one starting after it, once scanning falls back in step with `prev`, are
+ * read; the rest are carried over, shifted by the size of the edit.
+ */
+constexpr std::optional<Rescan> rescanForms(const FormTable &prev,
+                                            std::string_view src, Edit edit) {
+  Rescan rescan{};
+  const auto shift = static_cast<std::ptrdiff_t>(edit.inserted) -
+                     static_cast<std::ptrdiff_t>(edit.removed);
+
+  std::size_t i = 0;
+  while (i < prev.size() && prev[i].end < edit.offset)
+    rescan.forms.push_back(Form(prev[i++]));
+  rescan.delta.front = i;
+
+  // First form that lies entirely after the edit in the old text
+  while (i < prev.size() && prev[i].begin < edit.offset + edit.removed)
+    ++i;
+
+  auto pos = rescan.delta.front == 0 ? 0 : rescan.forms.back().end;
+  for (;;) {
+    const auto form = scanForm(src, pos);
+    if (!form)
+      return std::nullopt;
+    if (form->size() == 0)
+      return rescan;
+
+    while (i < prev.size() &&
+           detail::shifted(prev[i].begin, shift) < form->begin)
+      ++i;
+    if (i < prev.size() && detail::shifted(prev[i].begin, shift) == form->begin)
+      break;
+
+    pos = form->end;
+    rescan.forms.push_back(Form(*form));
+  }
+
+  // Back in step: the remaining text is unchanged
+  rescan.delta.back = prev.size() - i;
+  for (; i < prev.size(); ++i)
+    rescan.forms.push_back(Form{detail::shifted(prev[i].begin, shift),
+                                detail::shifted(prev[i].end, shift),
+                                prev[i].hash});
+  return rescan;
+}
+
+/**
+ * A parsed top-level form.
+ */
+template <typename TValue> struct Unit {
+  Form form{};
+  TValue value{};
+};
+
+template <typename TValue>
+using UnitTable = util::Vector<Unit<TValue>, kMaxForms>;
+
+/**
+ * Parses every form of `forms` with `p`. The form has to be consumed whole.
+ */
+template <typename TParser, typename TValue = Parser<TParser>>
+constexpr auto parseForms(const FormTable &forms, std::string_view src,
+                          TParser &&p) -> std::optional<UnitTable<TValue>> {
+  UnitTable<TValue> units{};
+  for (std::size_t i = 0; i < forms.size(); ++i) {
+    const auto result = p(forms[i].text(src));
+    if (!result || !result->second.empty())
+      return std::nullopt;
+    units.push_back(Unit<TValue>{forms[i], result->first});
+  }
+  return units;
+}
+
+/**
+ * Builds the units for `forms` from `prev`, running `p` only over forms
+ * inside the changed region of `delta` whose text is not already in `prev`.
+ * `prev` is left untouched, so a failed parse keeps the old units live and a
+ * successful one is swapped in with a single assignment.
+ */
+template <typename TParser, typename TValue = Parser<TParser>>
+constexpr auto reparseForms(const UnitTable<TValue> &prev,
+                            const FormTable &forms, Delta delta,
+                            std::string_view src, TParser &&p)
+    -> std::optional<UnitTable<TValue>> {
+  UnitTable<TValue> units{};
+  for (std::size_t i = 0; i < delta.front; ++i)
+    units.push_back(Unit<TValue>(prev[i]));
+
+  const auto prev_end = prev.size() - delta.back;
+  const auto next_end = forms.size() - delta.back;
+  for (auto i = delta.front; i < next_end; ++i) {
+    auto j = delta.front;
+    while (j < prev_end && !prev[j].form.sameText(forms[i]))
+      ++j;
+    if (j < prev_end) {
+      units.push_back(Unit<TValue>{forms[i], prev[j].value});
+      continue;
+    }
+    const auto result = p(forms[i].text(src));
+    if (!result || !result->second.empty())
+      return std::nullopt;
+    units.push_back(Unit<TValue>{forms[i], result->first});
+  }
+
+  for (auto i = next_end; i < forms.size(); ++i)
+    units.push_back(
+        Unit<TValue>{forms[i], prev[prev_end + i - next_end].value});
+  return units;
+}
+
+} // namespace cxlisp::parser::incremental
+
+#endif /* CXLISP_PARSER_INCREMENTAL_HPP_ */
@@ -82,8 +82,8 @@ public:
   constexpr auto back_insert_iter() { return m_data_.begin() + m_size_ - 1; }
 
 private:
-  std::array<T, kMaxSize> m_data_;
-  std::size_t m_size_;
+  std::array<T, kMaxSize> m_data_{};
+  std::size_t m_size_ = 0;
 };
 } // namespace cxlisp::util
 
@@ -15,4 +15,41 @@ constexpr auto stringParser = parseString();
 TEST_CASE("Parsing strings yields a string", "[parser]")
 {
     STATIC_REQUIRE(stringParser(R"("test")")->first == "test"_cxs);
-}
\ No newline at end of file
+}
+using namespace cxlisp::parser::incremental;
+
+constexpr std::string_view kRules = "1 22 ; comment\n333 4444";
+constexpr std::string_view kEdited = "1 22 ; comment\n5 333 4444";
+constexpr auto kForms = *scanForms(kRules);
+constexpr auto kRescan = *rescanForms(kForms, kEdited, Edit{15, 0, 2});
+
+TEST_CASE("Scanning splits top-level forms", "[parser][incremental]")
+{
+    STATIC_REQUIRE(kForms.size() == 4);
+    STATIC_REQUIRE(kForms[2].text(kRules) == "333");
+    STATIC_REQUIRE(scanForms("'(a \")\" b) c")->size() == 2);
+    STATIC_REQUIRE(!scanForms("(a (b)"));
+}
+
+TEST_CASE("Rescanning an edit only reads the changed forms", "[parser][incremental]")
+{
+    STATIC_REQUIRE(kRescan.forms.size() == 5);
+    STATIC_REQUIRE(kRescan.delta.front == 2);
+    STATIC_REQUIRE(kRescan.delta.back == 2);
+    STATIC_REQUIRE(kRescan.forms[4].text(kEdited) == "4444");
+
+    constexpr auto delta = diffForms(kForms, *scanForms(kEdited));
+    STATIC_REQUIRE(delta.front == kRescan.delta.front);
+    STATIC_REQUIRE(delta.back == kRescan.delta.back);
+}
+
+TEST_CASE("Reparsing keeps unchanged forms", "[parser][incremental]")
+{
+    constexpr auto units = *parseForms(kForms, kRules, numberParser());
+    constexpr auto reparsed = reparseForms(units, kRescan.forms, kRescan.delta,
+                                           kEdited, numberParser());
+    STATIC_REQUIRE(reparsed->size() == 5);
+    STATIC_REQUIRE((*reparsed)[2].value == 5);
+    STATIC_REQUIRE((*reparsed)[3].value == 333);
+    STATIC_REQUIRE((*reparsed)[4].form.begin == 21);
+}